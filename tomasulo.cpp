@@ -1,16 +1,25 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <vector>
 #include <deque>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <sstream>
 #include <string>
 #include <algorithm>
+#include <unistd.h>
 #include "tomasulo.hpp"
 
-// Vector to store instructions
-std::vector<inst_t> inst_list;
-// Deque for instruction pointers
-std::deque<inst_t *> insts;
+// Hardware threads sharing the stations and physical registers
+thread_t threads[SMT_MAX_THREADS];
+int thread_count = 0;
+// Issue policy and the thread it tries first in round-robin order
+smt_policy_t smt_policy = round_robin;
+int next_thread = 0;
 // Vector for reorder buffer pointers
 std::vector<inst_t *> reorder_buffer;
 // Clock ticks counter
@@ -25,25 +34,34 @@ const std::string str_reg[REGISTERS_MAX + 1] = {
     "ra", "rb", "rc", "rd", "re", "rf", "rg", "rh", "ri", "rj", "rk", "rl", "rm",
     "rn", "ro", "rp", "rq", "rr", "rs", "rt", "ru", "rv", "rw", "rx"};
 
+// Register names as written in instruction files, indexed by reg_t
+const std::string str_trace_reg[REGISTERS_MAX + 1] = {
+    "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r11",
+    "ra", "rb", "rc", "rd", "re", "rf", "rg", "rh", "ri", "rj", "rk", "rl", "rm",
+    "rn", "ro", "rp", "rq", "rr", "rs", "rt", "ru", "rv", "rw", "rx", "-"};
+
 // Functional unit names
 const std::string str_fus[ALL_STATIONS + 1] = {
     "-", "add1", "add2", "mult1", "mult2", "load1", "load2"};
 
+// Register usage names
+const std::string str_used[3] = {"free", "dest", "src"};
+
 // Register status array initialization
 regstat_t registers[REGISTERS_MAX + 1] = {
-    {-1, free_reg, -1, noreg, noreg, 0}};
+    {-1, free_reg, -1, noreg, noreg, 0, false}};
 
 // Add station initialization
 fu_t add_stations[ADD_STATIONS] = {
-    {0, false, nullptr, 0, 0, -1, -1, -1, 0, 0}};
+    {0, false, nullptr, 0, 0, -1, -1, -1, 0, 0, false, 0}};
 
 // Multiply station initialization
 fu_t mult_stations[MUL_STATIONS] = {
-    {0, false, nullptr, 0, 0, -1, -1, -1, 0, 0}};
+    {0, false, nullptr, 0, 0, -1, -1, -1, 0, 0, false, 0}};
 
 // Load station initialization
 fu_t load_stations[LOAD_STATIONS] = {
-    {0, false, nullptr, 0, 0, -1, -1, -1, 0, 0}};
+    {0, false, nullptr, 0, 0, -1, -1, -1, 0, 0, false, 0}};
 
 // Array of station sizes
 int station_sizes[STATION_TYPES] = {ADD_STATIONS, MUL_STATIONS, LOAD_STATIONS};
@@ -51,8 +69,54 @@ int station_sizes[STATION_TYPES] = {ADD_STATIONS, MUL_STATIONS, LOAD_STATIONS};
 // Array of all functional units
 fu_t *all_stations[STATION_TYPES] = {add_stations, mult_stations, load_stations};
 
-// Next Reorder
-static unsigned next_reorder = 0;
+// Execution ports of each unit class and the policy ordering the stations that compete for them
+int dispatch_ports[STATION_TYPES] = {ADD_PORTS, MUL_PORTS, LOAD_PORTS};
+dispatch_policy_t dispatch_policy = oldest_first;
+// Ready stations waiting for an execution port this cycle, by unit class
+std::vector<fu_t *> dispatch_requests[STATION_TYPES];
+// Execution port statistics
+dispatch_stats_t dispatch_stats = {};
+// Issue order of the next instruction
+unsigned long next_seq = 0;
+// Number of write-backs to each register
+unsigned long reg_writes[REGISTERS_MAX + 1] = {0};
+
+// Unit class names
+const std::string str_class[STATION_TYPES] = {"add", "mult", "load"};
+
+// Dispatch policy names
+const std::string str_dispatch[3] = {"oldest", "youngest", "station"};
+const std::string str_dispatch_order[3] = {"oldest first", "youngest first", "station order"};
+
+// Memoization mode flags
+bool memo_enabled = false;
+bool memo_verify = false;
+// Memoized steps, most recently used first
+std::list<std::pair<memo_state_t, memo_entry_t>> memo_cache;
+// Memoized steps indexed by the hash of their normalized starting state
+std::unordered_map<unsigned long long, std::list<std::pair<memo_state_t, memo_entry_t>>::iterator> memo_index;
+// Normalized state reused by every lookup so that its buffers are allocated once
+memo_state_t memo_scratch;
+// Memoization statistics
+memo_stats_t memo_stats = {0, 0, 0, 0, 0, 0};
+
+// Conditions that stop every run
+std::vector<breakpoint_t> breakpoints;
+// Registers whose status changes stop every run
+std::vector<reg_t> watchpoints;
+
+// Result cache mode flags
+bool result_cache_enabled = false;
+bool result_cache_timeline = false;
+// Indicates if the results of this run are already in the cache
+bool result_cache_stored = false;
+// Indicates if the results were loaded from the cache, leaving the machine state unsimulated
+bool result_cache_hit = false;
+// Hash of the trace contents
+std::string result_cache_trace;
+
+// Timing fields tracked by memoized steps
+int inst_t::*const memo_fields[4] = {&inst_t::issue, &inst_t::exec, &inst_t::write, &inst_t::commit};
 
 void init_fus()
 {
@@ -86,6 +150,10 @@ void init_fus()
             // Initialize the lock flags
             all_stations[i][j].locks1 = false;
             all_stations[i][j].locks2 = false;
+
+            // Initialize the dispatch state
+            all_stations[i][j].dispatched = false;
+            all_stations[i][j].seq = 0;
         }
     }
 }
@@ -99,7 +167,7 @@ void rename(inst_t *i)
         // Find a free register to use for renaming
         for (int j = VISIBLE_REGISTERS + 1; j <= REGISTERS_MAX; j++)
         {
-            if (registers[j].used_as == free_reg)
+            if (registers[j].used_as == free_reg && !registers[j].reserved)
             {
                 rename = (reg_t)j;
                 registers[rename].used_as = dest; // Mark as destination
@@ -120,7 +188,7 @@ void rename(inst_t *i)
         // Find a free register to use for renaming
         for (int j = VISIBLE_REGISTERS + 1; j <= REGISTERS_MAX; j++)
         {
-            if (registers[j].used_as == free_reg)
+            if (registers[j].used_as == free_reg && !registers[j].reserved)
             {
                 rename = (reg_t)j;
                 registers[rename].used_as = src; // Mark as source
@@ -147,7 +215,7 @@ void rename(inst_t *i)
         // Find a free register to use for renaming
         for (int j = VISIBLE_REGISTERS + 1; j <= REGISTERS_MAX; j++)
         {
-            if (registers[j].used_as == free_reg)
+            if (registers[j].used_as == free_reg && !registers[j].reserved)
             {
                 rename = (reg_t)j;
                 registers[rename].used_as = src; // Mark as source
@@ -168,15 +236,77 @@ void rename(inst_t *i)
     }
 }
 
+bool station_free(op_t op)
+{
+    // Check if a station of the type executing the operation is free
+    for (int j = 0; j < station_sizes[op % STATION_TYPES]; j++)
+    {
+        if (!all_stations[op % STATION_TYPES][j].busy)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int in_flight(int t)
+{
+    // Count the instructions of the thread held by the stations
+    int count = 0;
+    for (int i = 0; i < STATION_TYPES; i++)
+    {
+        for (int j = 0; j < station_sizes[i]; j++)
+        {
+            if (all_stations[i][j].inst != nullptr && all_stations[i][j].inst->thread == t)
+            {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+int select_thread()
+{
+    // Order the threads with instructions to issue, starting from the round-robin choice
+    std::vector<int> order;
+    for (int k = 0; k < thread_count; k++)
+    {
+        int t = (next_thread + k) % thread_count;
+        if (!threads[t].insts.empty())
+        {
+            order.push_back(t);
+        }
+    }
+    next_thread = (next_thread + 1) % thread_count;
+
+    // Under ICOUNT, prefer the threads with the fewest instructions in the stations
+    if (smt_policy == icount)
+    {
+        std::stable_sort(order.begin(), order.end(), [](int a, int b) { return in_flight(a) < in_flight(b); });
+    }
+
+    // Take the first thread whose next instruction finds a free station, or stall on the first one
+    for (int t : order)
+    {
+        if (station_free(threads[t].insts.front()->op))
+        {
+            return t;
+        }
+    }
+    return order.empty() ? -1 : order[0];
+}
+
 void issue()
 {
-    // Check if there are instructions to issue
-    if (insts.empty())
+    // Choose the thread to issue from, if any has instructions left
+    int t = select_thread();
+    if (t == -1)
     {
         return;
     }
-    // Get the instruction from the front of the instruction queue
-    inst_t *i = insts.front();
+    // Get the instruction from the front of the thread's instruction queue
+    inst_t *i = threads[t].insts.front();
 
     // Check if registers must be renamed before issuing the instruction
     rename(i);
@@ -199,8 +329,9 @@ void issue()
     if (empty_station != -1)
     {
         stations[empty_station].inst = i; // Assign the instruction to the station
+        stations[empty_station].seq = next_seq++; // Record the issue order
         i->issue = ticks;                 // Record the issue time
-        insts.pop_front();                // Remove the instruction from the queue
+        threads[t].insts.pop_front();     // Remove the instruction from the queue
     }
 }
 
@@ -232,7 +363,57 @@ void undo_rename(reg_t reg)
     registers[registers[reg].renamed_from].value = registers[reg].value;
 }
 
-void exec_fu(fu_t *fu)
+void advance_fu(fu_t *fu)
+{
+    // Decrement time left for execution
+    fu->time_left--;
+
+    // Check if execution is finished
+    if (fu->time_left == 1)
+    {
+        // If execution is finished, mark the execution time
+        fu->inst->exec = ticks;
+    }
+    else if (fu->time_left == 0)
+    {
+        // If the execution is completed:
+
+        // Mark the write time
+        fu->inst->write = ticks;
+
+        // Count the write-back to the destination register and to every register it renames
+        reg_t dest = fu->inst->dest;
+        reg_writes[dest]++;
+        for (int k = 0; k < INVISIBLE_REGISTERS && dest > VISIBLE_REGISTERS && !registers[dest].reserved && registers[dest].renamed_from != noreg; k++)
+        {
+            dest = registers[dest].renamed_from;
+            reg_writes[dest]++;
+        }
+
+        // Write the result to the destination register and undo renaming
+        registers[fu->inst->dest].value = fu->id + 1;
+        undo_rename(fu->inst->dest);
+        undo_rename(fu->inst->src1);
+        undo_rename(fu->inst->src2);
+
+        // Place the instruction to the reorder buffer
+        reorder_buffer.push_back(fu->inst);
+
+        // Reset functional unit state
+        fu->busy = false;
+        fu->inst = nullptr;
+        fu->time_left = -1;
+        fu->vj = 0;
+        fu->vk = 0;
+        fu->qj = -1;
+        fu->qk = -1;
+        fu->locks1 = false;
+        fu->locks2 = false;
+        fu->dispatched = false;
+    }
+}
+
+void exec_fu(fu_t *fu, int c)
 {
     // Macro to check if a register is used as destination by another instruction and not by the current functional unit
 #define USED_AS_DEST(reg) (registers[reg].used_as == dest && registers[reg].dest_used_by != -1 && registers[reg].dest_used_by != fu->id)
@@ -270,42 +451,15 @@ void exec_fu(fu_t *fu)
             fu->locks2 = false;
         }
 
-        // Decrement time left for execution
-        fu->time_left--;
-
-        // Check if execution is finished
-        if (fu->time_left == 1)
+        // Wait for an execution port before the first cycle of execution
+        if (!fu->dispatched)
         {
-            // If execution is finished, mark the execution time
-            fu->inst->exec = ticks;
+            dispatch_requests[c].push_back(fu);
+            return;
         }
-        else if (fu->time_left == 0)
-        {
-            // If the execution is completed:
-
-            // Mark the write time
-            fu->inst->write = ticks;
-
-            // Write the result to the destination register and undo renaming
-            registers[fu->inst->dest].value = fu->id + 1;
-            undo_rename(fu->inst->dest);
-            undo_rename(fu->inst->src1);
-            undo_rename(fu->inst->src2);
-
-            // Place the instruction to the reorder buffer
-            reorder_buffer.push_back(fu->inst);
 
-            // Reset functional unit state
-            fu->busy = false;
-            fu->inst = nullptr;
-            fu->time_left = -1;
-            fu->vj = 0;
-            fu->vk = 0;
-            fu->qj = -1;
-            fu->qk = -1;
-            fu->locks1 = false;
-            fu->locks2 = false;
-        }
+        // Continue executing
+        advance_fu(fu);
     }
     else
     {
@@ -358,25 +512,73 @@ void exec_fu(fu_t *fu)
     }
 }
 
-void reorder()
+void dispatch()
 {
-    // Find the next instruction to commit in the reorder buffer
-    auto i = std::find(reorder_buffer.begin(), reorder_buffer.end(), &inst_list[next_reorder]);
+    for (int c = 0; c < STATION_TYPES; c++)
+    {
+        // The ready stations of the unit class were requested in station order
+        std::vector<fu_t *> &ready = dispatch_requests[c];
+
+        // Order the stations by the dispatch policy
+        if (dispatch_policy == oldest_first)
+        {
+            std::stable_sort(ready.begin(), ready.end(), [](const fu_t *a, const fu_t *b) { return a->seq < b->seq; });
+        }
+        else if (dispatch_policy == youngest_first)
+        {
+            std::stable_sort(ready.begin(), ready.end(), [](const fu_t *a, const fu_t *b) { return a->seq > b->seq; });
+        }
+
+        // Start the first stations on the free ports, the others wait for the next cycle
+        for (size_t k = 0; k < ready.size(); k++)
+        {
+            if ((int)k < dispatch_ports[c])
+            {
+                ready[k]->dispatched = true;
+                dispatch_stats.grants[c][k]++;
+                advance_fu(ready[k]);
+            }
+            else
+            {
+                dispatch_stats.waits[c]++;
+            }
+        }
+        ready.clear();
+    }
+}
 
-    // Continue until either the end of the reorder buffer is reached or all instructions are committed
-    while (i != reorder_buffer.end() && next_reorder < inst_list.size())
+void reorder()
+{
+    // Commit each thread's instructions in its own program order
+    for (int t = 0; t < thread_count; t++)
     {
-        // Commit the instruction by marking its commit time
-        (*i)->commit = ticks;
+        thread_t &th = threads[t];
+
+        // Continue until either all instructions are committed or the next one is not in the reorder buffer
+        while (th.next_reorder < th.inst_list.size())
+        {
+            // Find the next instruction to commit in the reorder buffer
+            auto i = std::find(reorder_buffer.begin(), reorder_buffer.end(), &th.inst_list[th.next_reorder]);
+            if (i == reorder_buffer.end())
+            {
+                break;
+            }
+
+            // Commit the instruction by marking its commit time
+            (*i)->commit = ticks;
 
-        // Remove the instruction from the reorder buffer
-        reorder_buffer.erase(i);
+            // Remove the instruction from the reorder buffer
+            reorder_buffer.erase(i);
 
-        // Move to the next instruction in the inst_list
-        next_reorder++;
+            // Move to the next instruction in the inst_list
+            th.next_reorder++;
 
-        // Find the next instruction to commit in the reorder buffer
-        i = std::find(reorder_buffer.begin(), reorder_buffer.end(), &inst_list[next_reorder]);
+            // Record when the thread finished
+            if (th.next_reorder == th.inst_list.size())
+            {
+                th.finish = ticks;
+            }
+        }
     }
 }
 
@@ -396,8 +598,11 @@ int exec()
         }
     }
 
-    // Check if the instruction queue is empty
-    ret = ret && insts.empty();
+    // Check if the instruction queues are empty
+    for (int t = 0; t < thread_count; t++)
+    {
+        ret = ret && threads[t].insts.empty();
+    }
 
     // If all instructions are executed and the instruction queue is empty, return
     if (ret)
@@ -414,154 +619,1212 @@ int exec()
     {
         for (int j = 0; j < station_sizes[i]; j++)
         {
-            exec_fu(&all_stations[i][j]); // Execute functional unit
+            exec_fu(&all_stations[i][j], i); // Execute functional unit
         }
     }
 
+    // Start the ready stations on the execution ports
+    dispatch();
+
     // Reorder the buffer
     reorder();
 
     return ret; // Return whether all instructions are executed
 }
 
-void fus()
+void memo_snapshot(unsigned base, unsigned window, memo_state_t *s)
 {
-    // Print header for functional units status
-    std::cout << "Unidades Funcionais:\n";
-    std::cout << "Time\tFU\tBusy\tOp\tVi\tVj\tVk\tQj\tQk\n";
+    thread_t &th = threads[0]; // Memoization runs on single-thread traces only
 
-    // Loop through all functional units
+    // Copy the register status
+    std::copy(registers, registers + REGISTERS_MAX + 1, s->registers);
+
+    // Copy the functional units, replacing instruction pointers by relative indices
+    int k = 0;
     for (int i = 0; i < STATION_TYPES; i++)
     {
         for (int j = 0; j < station_sizes[i]; j++)
         {
-            // Print status of each functional unit
-            if (all_stations[i][j].time_left != -1)
-            {
-                // Print remaining execution time if the unit is busy
-                std::cout << all_stations[i][j].time_left;
-            }
-            std::cout << "\t" << str_fus[(2 * i) + j + 1] << "\t" << all_stations[i][j].busy << "\t"; // Print unit ID and busy status
+            fu_t *fu = &all_stations[i][j];
+            memo_fu_t &m = s->stations[k++];
+            m.busy = fu->busy;
+            m.inst = fu->inst != nullptr ? (int)(fu->inst - th.inst_list.data()) - (int)base : 0;
+            m.vj = fu->vj;
+            m.vk = fu->vk;
+            m.qj = fu->qj;
+            m.qk = fu->qk;
+            m.time_left = fu->time_left;
+            m.locks1 = fu->locks1;
+            m.locks2 = fu->locks2;
+            m.dispatched = fu->dispatched;
+            m.age = fu->inst != nullptr ? (int)(next_seq - fu->seq) : 0;
+        }
+    }
 
-            if (all_stations[i][j].busy)
-            {
-                // If the unit is busy, print the operation it is executing
-                std::cout << str_op[all_stations[i][j].inst->op];
-            }
-            else
-            {
-                // If the unit is idle, print a dash
-                std::cout << "-";
-            }
-            std::cout << "\t";
+    // Copy the reorder buffer and the commit position
+    s->reorder_buffer.clear();
+    for (inst_t *i : reorder_buffer)
+    {
+        s->reorder_buffer.push_back((int)(i - th.inst_list.data()) - (int)base);
+    }
+    s->next_reorder = (int)th.next_reorder - (int)base;
 
-            if (all_stations[i][j].inst != nullptr)
-            {
-                // If there is an instruction in the unit, print its destination register
-                std::cout << str_reg[all_stations[i][j].inst->dest];
-            }
-            else
-            {
-                // If no instruction is in the unit, print a dash
-                std::cout << "-";
-            }
-            std::cout << "\t" << str_reg[all_stations[i][j].vj] << "\t" << str_reg[all_stations[i][j].vk] << "\t"; // Print source operands (Vj and Vk)
+    // Copy the execution port configuration, which changes how every step unfolds
+    std::copy(dispatch_ports, dispatch_ports + STATION_TYPES, s->dispatch_ports);
+    s->dispatch_policy = dispatch_policy;
 
-            // Print reservation stations for source operands (Qj and Qk)
-            std::cout << str_fus[all_stations[i][j].qj + 1] << "\t" << str_fus[all_stations[i][j].qk + 1] << "\n";
+    // Copy the instructions that are still in flight or will be issued within the window
+    s->insts.clear();
+    for (unsigned i = th.next_reorder; i < base + window; i++)
+    {
+        s->insts.push_back({th.inst_list[i].op, th.inst_list[i].dest, th.inst_list[i].src1, th.inst_list[i].src2, th.inst_list[i].time});
+    }
+}
+
+void memo_restore(const memo_state_t &s, unsigned base)
+{
+    thread_t &th = threads[0]; // Memoization runs on single-thread traces only
+    // Restore the register status
+    std::copy(s.registers, s.registers + REGISTERS_MAX + 1, registers);
+
+    // Restore the functional units
+    int k = 0;
+    for (int i = 0; i < STATION_TYPES; i++)
+    {
+        for (int j = 0; j < station_sizes[i]; j++)
+        {
+            fu_t *fu = &all_stations[i][j];
+            const memo_fu_t &m = s.stations[k++];
+            fu->busy = m.busy;
+            fu->inst = m.inst != 0 ? &th.inst_list[base + m.inst] : nullptr;
+            fu->vj = m.vj;
+            fu->vk = m.vk;
+            fu->qj = m.qj;
+            fu->qk = m.qk;
+            fu->time_left = m.time_left;
+            fu->locks1 = m.locks1;
+            fu->locks2 = m.locks2;
+            fu->dispatched = m.dispatched;
+            fu->seq = m.age != 0 ? next_seq - m.age : 0;
         }
     }
-    std::cout << "\n"; // Add a newline for better readability
+
+    // Restore the reorder buffer and the commit position
+    reorder_buffer.clear();
+    for (int i : s.reorder_buffer)
+    {
+        reorder_buffer.push_back(&th.inst_list[base + i]);
+    }
+    th.next_reorder = base + s.next_reorder;
+
+    // Restore the renamed registers of the instructions in flight
+    for (size_t i = 0; i < s.insts.size(); i++)
+    {
+        inst_t &inst = th.inst_list[th.next_reorder + i];
+        inst.dest = s.insts[i].dest;
+        inst.src1 = s.insts[i].src1;
+        inst.src2 = s.insts[i].src2;
+    }
 }
 
-void show()
+unsigned long long memo_hash(const memo_state_t &s)
 {
-    // Print header for the registers display
-    std::cout << "Registradores: \n";
-    std::cout << "Visiveis       |      Invisiveis\n";
+    // Hash every field with 64-bit FNV-1a over whole words, so that structure padding never reaches the hash
+    unsigned long long hash = 14695981039346656037ULL;
+    auto put = [&hash](int v) { hash = (hash ^ (unsigned)v) * 1099511628211ULL; };
 
-    // Loop through visible registers and their corresponding invisible registers
-    for (int i = 1; i <= VISIBLE_REGISTERS; i++)
+    for (const regstat_t &r : s.registers)
     {
-        // Print the value of each visible register and its corresponding invisible registers
-        std::cout << str_reg[i] << ": " << registers[i].value << "\t\t    " << str_reg[i + VISIBLE_REGISTERS] << ": " << registers[i + VISIBLE_REGISTERS].value << "\t" << str_reg[i + (2 * VISIBLE_REGISTERS)] << ": " << registers[i + (2 * VISIBLE_REGISTERS)].value << "\n";
+        put(r.value);
+        put(r.used_as);
+        put(r.dest_used_by);
+        put(r.renamed_to);
+        put(r.renamed_from);
+        put(std::min(r.rename_ref_count, MEMO_REF_LIMIT));
     }
-    std::cout << "\n"; // Add a newline for better readability
+    for (const memo_fu_t &fu : s.stations)
+    {
+        put(fu.busy);
+        put(fu.inst);
+        put(fu.vj);
+        put(fu.vk);
+        put(fu.qj);
+        put(fu.qk);
+        put(fu.time_left);
+        put(fu.locks1);
+        put(fu.locks2);
+        put(fu.dispatched);
+        put(fu.age);
+    }
+    put((int)s.reorder_buffer.size());
+    for (int i : s.reorder_buffer)
+    {
+        put(i);
+    }
+    put(s.next_reorder);
+    for (int i = 0; i < STATION_TYPES; i++)
+    {
+        put(s.dispatch_ports[i]);
+    }
+    put(s.dispatch_policy);
+    put((int)s.insts.size());
+    for (const memo_inst_t &i : s.insts)
+    {
+        put(i.op);
+        put(i.dest);
+        put(i.src1);
+        put(i.src2);
+        put(i.time);
+    }
+    return hash;
 }
 
-void menu()
+bool memo_same(const memo_state_t &a, const memo_state_t &b)
 {
-    // Print menu options
-    std::cout << "Menu:\n";
-    std::cout << "\tCycle (c)\n";           // Option to execute one cycle
-    std::cout << "\tExit (e)\n";            // Option to exit the program
-    std::cout << "\tFunctional units (f)\n"; // Option to display functional units status
-    std::cout << "\tNext (n)\n";            // Option to execute until the next instruction is issued
-    std::cout << "\tRegister (r)\n";   // Option to display register values
+    // Compare the fields memo_hash covers, so that hash collisions read as misses
+    for (int i = 0; i <= REGISTERS_MAX; i++)
+    {
+        const regstat_t &x = a.registers[i], &y = b.registers[i];
+        if (x.value != y.value || x.used_as != y.used_as || x.dest_used_by != y.dest_used_by || x.renamed_to != y.renamed_to ||
+            x.renamed_from != y.renamed_from || std::min(x.rename_ref_count, MEMO_REF_LIMIT) != std::min(y.rename_ref_count, MEMO_REF_LIMIT))
+        {
+            return false;
+        }
+    }
+    for (int i = 0; i < ALL_STATIONS; i++)
+    {
+        const memo_fu_t &x = a.stations[i], &y = b.stations[i];
+        if (x.busy != y.busy || x.inst != y.inst || x.vj != y.vj || x.vk != y.vk || x.qj != y.qj || x.qk != y.qk || x.time_left != y.time_left ||
+            x.locks1 != y.locks1 || x.locks2 != y.locks2 || x.dispatched != y.dispatched || x.age != y.age)
+        {
+            return false;
+        }
+    }
+    if (a.reorder_buffer != b.reorder_buffer || a.next_reorder != b.next_reorder || a.dispatch_policy != b.dispatch_policy ||
+        !std::equal(a.dispatch_ports, a.dispatch_ports + STATION_TYPES, b.dispatch_ports) || a.insts.size() != b.insts.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.insts.size(); i++)
+    {
+        const memo_inst_t &x = a.insts[i], &y = b.insts[i];
+        if (x.op != y.op || x.dest != y.dest || x.src1 != y.src1 || x.src2 != y.src2 || x.time != y.time)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
-std::vector<inst_t> read(const std::string &filename)
+bool memo_equal(const memo_entry_t &a, const memo_entry_t &b)
 {
-    std::vector<inst_t> code;
-    static std::map<std::string, op_t> op_map;
+    // Compare cycle counts, reference count changes, write-backs and execution port statistics
+    if (a.ticks != b.ticks || !std::equal(a.ref_delta, a.ref_delta + REGISTERS_MAX + 1, b.ref_delta) ||
+        !std::equal(a.write_delta, a.write_delta + REGISTERS_MAX + 1, b.write_delta) ||
+        !std::equal(a.dispatch_delta.waits, a.dispatch_delta.waits + STATION_TYPES, b.dispatch_delta.waits) ||
+        !std::equal(&a.dispatch_delta.grants[0][0], &a.dispatch_delta.grants[0][0] + STATION_TYPES * ALL_STATIONS, &b.dispatch_delta.grants[0][0]))
+    {
+        return false;
+    }
 
-    // Initialize op_map if empty
-    if (op_map.empty())
+    // Compare resulting states, leaving out the reference counts already compared as changes
+    memo_state_t ra = a.result, rb = b.result;
+    for (int i = 0; i <= REGISTERS_MAX; i++)
     {
-        // Mapping operation strings to op_t enum values
-        op_map["add"] = add;
-        op_map["sub"] = sub;
-        op_map["mul"] = mul;
-        op_map["div"] = divd;
-        op_map["lw "] = lw;
-        op_map["sw "] = sw;
+        ra.registers[i].rename_ref_count = 0;
+        rb.registers[i].rename_ref_count = 0;
+    }
+    if (!memo_same(ra, rb) || a.events.size() != b.events.size())
+    {
+        return false;
     }
 
-    static std::map<std::string, reg_t> reg_map;
+    // Compare the timing fields written during the step
+    for (size_t i = 0; i < a.events.size(); i++)
+    {
+        if (a.events[i].inst != b.events[i].inst || a.events[i].field != b.events[i].field || a.events[i].delta != b.events[i].delta)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-    // Initialize reg_map if empty
-    if (reg_map.empty())
+memo_entry_t memo_run(unsigned base)
+{
+    thread_t &th = threads[0]; // Memoization runs on single-thread traces only
+    unsigned start_ticks = ticks;
+    unsigned first = th.next_reorder;
+    unsigned last = base + MEMO_WINDOW;
+
+    // Save the timing fields and reference counts that may change during the step
+    std::vector<inst_t> before(th.inst_list.begin() + first, th.inst_list.begin() + last);
+    int refs[REGISTERS_MAX + 1];
+    for (int i = 0; i <= REGISTERS_MAX; i++)
     {
-        // Mapping register strings to reg_t enum values
-        // Mapping visible registers
-        reg_map["r0"] = r0;
-        reg_map["r1"] = r1;
-        reg_map["r2"] = r2;
-        reg_map["r3"] = r3;
-        reg_map["r4"] = r4;
-        reg_map["r5"] = r5;
-        reg_map["r6"] = r6;
-        reg_map["r7"] = r7;
-        reg_map["r8"] = r8;
-        reg_map["r9"] = r9;
-        reg_map["r10"] = r10;
-        reg_map["ra"] = ra;
-        reg_map["rb"] = rb;
-        reg_map["rc"] = rc;
-        reg_map["rd"] = rd;
-        reg_map["re"] = re;
-        reg_map["rf"] = rf;
-        reg_map["rg"] = rg;
-        reg_map["rh"] = rh;
-        reg_map["ri"] = ri;
-        reg_map["rj"] = rj;
-        reg_map["rk"] = rk;
-        reg_map["rl"] = rl;
-        reg_map["rm"] = rm;
-        reg_map["rn"] = rn;
-        reg_map["ro"] = ro;
-        reg_map["rp"] = rp;
-        reg_map["rq"] = rq;
-        reg_map["rr"] = rr;
-        reg_map["rs"] = rs;
-        reg_map["rt"] = rt;
-        reg_map["ru"] = ru;
-        reg_map["rv"] = rv;
-        reg_map["rw"] = rw;
-        reg_map["rx"] = rx;
+        refs[i] = registers[i].rename_ref_count;
     }
+    dispatch_stats_t stats = dispatch_stats;
+    unsigned long writes[REGISTERS_MAX + 1];
+    std::copy(reg_writes, reg_writes + REGISTERS_MAX + 1, writes);
 
-    static int op_time[6] = {add_time, sub_time, mul_time, lw_time, div_time, sw_time};
+    // Simulate cycle by cycle until the whole window has been issued
+    while (th.inst_list.size() - th.insts.size() < last)
+    {
+        exec();
+    }
+
+    // Record the resulting state and the timing fields that changed
+    memo_entry_t entry;
+    memo_snapshot(last, 0, &entry.result);
+    entry.ticks = ticks - start_ticks;
+    for (int i = 0; i <= REGISTERS_MAX; i++)
+    {
+        entry.ref_delta[i] = registers[i].rename_ref_count - refs[i];
+        entry.write_delta[i] = reg_writes[i] - writes[i];
+    }
+    for (int c = 0; c < STATION_TYPES; c++)
+    {
+        entry.dispatch_delta.waits[c] = dispatch_stats.waits[c] - stats.waits[c];
+        for (int k = 0; k < ALL_STATIONS; k++)
+        {
+            entry.dispatch_delta.grants[c][k] = dispatch_stats.grants[c][k] - stats.grants[c][k];
+        }
+    }
+    for (unsigned i = first; i < last; i++)
+    {
+        for (int inst_t::*field : memo_fields)
+        {
+            if (th.inst_list[i].*field != before[i - first].*field)
+            {
+                entry.events.push_back({(int)i - (int)base, field, th.inst_list[i].*field - (int)start_ticks});
+            }
+        }
+    }
+    return entry;
+}
+
+void memo_replay(const memo_entry_t &entry, unsigned base)
+{
+    thread_t &th = threads[0]; // Memoization runs on single-thread traces only
+    // Write the timing fields relative to the current cycle
+    for (const memo_event_t &e : entry.events)
+    {
+        th.inst_list[base + e.inst].*e.field = (int)ticks + e.delta;
+    }
+
+    // Advance the clock, the instruction queue and the issue order past the window
+    ticks += entry.ticks;
+    for (int i = 0; i < MEMO_WINDOW; i++)
+    {
+        th.insts.pop_front();
+    }
+    next_seq += MEMO_WINDOW;
+
+    // Add the execution port statistics of the window
+    for (int c = 0; c < STATION_TYPES; c++)
+    {
+        dispatch_stats.waits[c] += entry.dispatch_delta.waits[c];
+        for (int k = 0; k < ALL_STATIONS; k++)
+        {
+            dispatch_stats.grants[c][k] += entry.dispatch_delta.grants[c][k];
+        }
+    }
+
+    // Restore the state reached at the end of the window, applying reference count changes to the current counts
+    int refs[REGISTERS_MAX + 1];
+    for (int i = 0; i <= REGISTERS_MAX; i++)
+    {
+        refs[i] = registers[i].rename_ref_count;
+    }
+    memo_restore(entry.result, base + MEMO_WINDOW);
+    for (int i = 0; i <= REGISTERS_MAX; i++)
+    {
+        registers[i].rename_ref_count = refs[i] + entry.ref_delta[i];
+        reg_writes[i] += entry.write_delta[i];
+    }
+}
+
+int memo_exec()
+{
+    thread_t &th = threads[0];
+
+    // Step a single cycle when memoization is disabled, several threads share the core or the window would pass the end of the trace
+    if (!memo_enabled || thread_count > 1 || th.insts.size() < MEMO_WINDOW)
+    {
+        return exec();
+    }
+
+    // Look up the normalized state together with the next instructions to issue
+    unsigned base = th.inst_list.size() - th.insts.size();
+    memo_snapshot(base, MEMO_WINDOW, &memo_scratch);
+    unsigned long long key = memo_hash(memo_scratch);
+    auto hit = memo_index.find(key);
+
+    if (hit != memo_index.end() && memo_same(hit->second->first, memo_scratch))
+    {
+        // Move the entry to the front of the cache
+        memo_stats.hits++;
+        memo_cache.splice(memo_cache.begin(), memo_cache, hit->second);
+        const memo_entry_t &cached = hit->second->second;
+
+        if (memo_verify)
+        {
+            // Simulate the step in full and check it against the cached outcome
+            memo_stats.verified++;
+            unsigned start_ticks = ticks;
+            if (!memo_equal(memo_run(base), cached))
+            {
+                memo_stats.mismatches++;
+                std::cout << "Memoization mismatch at cycle " << start_ticks << "\n";
+            }
+        }
+        else
+        {
+            // Replay the cached step
+            memo_stats.cycles += cached.ticks;
+            memo_replay(cached, base);
+        }
+        return 0;
+    }
+
+    // Simulate the step and cache its outcome
+    memo_stats.misses++;
+    memo_cache.emplace_front(memo_scratch, memo_run(base));
+    memo_index[key] = memo_cache.begin();
+
+    // Evict the least recently used entries (an entry whose hash collided may have lost its index slot already)
+    while (memo_cache.size() > MEMO_CACHE_SIZE)
+    {
+        auto last = memo_index.find(memo_hash(memo_cache.back().first));
+        if (last != memo_index.end() && last->second == std::prev(memo_cache.end()))
+        {
+            memo_index.erase(last);
+        }
+        memo_cache.pop_back();
+        memo_stats.evictions++;
+    }
+    return 0;
+}
+
+void memo_show()
+{
+    // Print memoization mode and statistics
+    std::cout << "Memoization: " << (memo_enabled ? (memo_verify ? "verify" : "on") : "off") << "\n";
+    std::cout << "Hits: " << memo_stats.hits << "\tMisses: " << memo_stats.misses << "\tEvictions: " << memo_stats.evictions << "\tEntries: " << memo_cache.size() << "\n";
+    std::cout << "Cycles replayed: " << memo_stats.cycles << "\tVerified: " << memo_stats.verified << "\tMismatches: " << memo_stats.mismatches << "\n";
+    std::cout << "\n"; // Add a newline for better readability
+}
+
+void dataflow_init(dataflow_t *df)
+{
+    // Every register is ready before the first cycle and no window has been measured
+    *df = dataflow_t();
+}
+
+void dataflow_add(dataflow_t *df, const inst_t &i)
+{
+    // The instruction starts once both source operands are ready (true dependencies only)
+    reg_t s1 = i.src1, s2 = i.src2;
+    unsigned long start = std::max(df->ready[s1], df->ready[s2]);
+    unsigned long finish = start + i.time;
+    unsigned long depth = std::max(df->depth[s1], df->depth[s2]) + 1;
+
+    // Update the critical path when this instruction finishes last
+    if (finish > df->cycles)
+    {
+        df->cycles = finish;
+        df->path_insts = depth;
+        df->path_end = df->insts;
+    }
+
+    // Record when the destination register becomes ready (false dependencies are renamed away)
+    if (i.dest != noreg)
+    {
+        df->ready[i.dest] = finish;
+        df->depth[i.dest] = depth;
+    }
+
+    // Repeat the schedule counting only dependencies within the current window
+    unsigned long window_finish = std::max(df->window_ready[s1], df->window_ready[s2]) + i.time;
+    df->window_cycles = std::max(df->window_cycles, window_finish);
+    if (i.dest != noreg)
+    {
+        df->window_ready[i.dest] = window_finish;
+    }
+    df->insts++;
+
+    // Close the window once it is full
+    if (df->insts % ILP_WINDOW == 0)
+    {
+        double ilp = (double)ILP_WINDOW / df->window_cycles;
+        df->ilp_sum += ilp;
+        df->ilp_min = df->windows == 0 ? ilp : std::min(df->ilp_min, ilp);
+        df->ilp_max = df->windows == 0 ? ilp : std::max(df->ilp_max, ilp);
+        df->windows++;
+        std::fill(df->window_ready, df->window_ready + REGISTERS_MAX + 1, 0);
+        df->window_cycles = 0;
+    }
+}
+
+void dataflow_show(const dataflow_t &df, unsigned cycles)
+{
+    // Print the dataflow limit next to the simulated cycle count
+    std::cout << "Dataflow limit:\n";
+    std::cout << "Simulated cycles: " << cycles << "\tDataflow cycles: " << df.cycles;
+    if (cycles > 0)
+    {
+        std::cout << "\tReached: " << 100.0 * df.cycles / cycles << "%";
+    }
+    std::cout << "\n";
+
+    // Print the critical path and the overall ILP
+    std::cout << "Critical path: " << df.path_insts << " instructions ending at instruction " << df.path_end << "\n";
+    if (df.cycles > 0)
+    {
+        std::cout << "ILP: " << (double)df.insts / df.cycles;
+    }
+
+    // Print the ILP available within windows of ILP_WINDOW instructions
+    if (df.windows > 0)
+    {
+        std::cout << "\tWindow ILP (" << ILP_WINDOW << " instructions): avg " << df.ilp_sum / df.windows << " min " << df.ilp_min << " max " << df.ilp_max;
+    }
+    std::cout << "\n\n"; // Add a newline for better readability
+}
+
+unsigned long long fnv1a(const std::string &data, unsigned long long hash = 14695981039346656037ULL)
+{
+    // Hash the bytes with 64-bit FNV-1a
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+unsigned long long sdbm(const std::string &data, unsigned long long hash = 0)
+{
+    // Hash the bytes with 64-bit sdbm, independent of FNV-1a
+    for (unsigned char c : data)
+    {
+        hash = c + (hash << 6) + (hash << 16) - hash;
+    }
+    return hash;
+}
+
+std::string machine_config()
+{
+    // Describe every parameter that can change the simulated results
+    std::ostringstream config;
+    config << "registers=" << VISIBLE_REGISTERS << "/" << INVISIBLE_REGISTERS;
+    config << ";latency=" << add_time << "/" << sub_time << "/" << mul_time << "/" << div_time << "/" << lw_time << "/" << sw_time;
+    config << ";stations=" << ADD_STATIONS << "/" << MUL_STATIONS << "/" << LOAD_STATIONS;
+    config << ";ports=" << dispatch_ports[0] << "/" << dispatch_ports[1] << "/" << dispatch_ports[2];
+    config << ";dispatch=" << str_dispatch[dispatch_policy];
+    config << ";threads=" << thread_count << ";policy=" << (smt_policy == icount ? "icount" : "round-robin");
+    return config.str();
+}
+
+void result_cache_open()
+{
+    // Digest the contents of every thread's trace with two independent hashes and the trace sizes, separating the traces
+    unsigned long long hash = fnv1a(""), check = sdbm("");
+    std::ostringstream sizes;
+    for (int t = 0; t < thread_count; t++)
+    {
+        std::ifstream file(threads[t].filename, std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        hash = fnv1a(std::string(1, '\0'), fnv1a(contents.str(), hash));
+        check = sdbm(std::string(1, '\0'), sdbm(contents.str(), check));
+        sizes << " " << contents.str().size();
+    }
+    std::ostringstream trace;
+    trace << std::hex << hash << " " << check << std::dec << sizes.str();
+    result_cache_trace = trace.str();
+}
+
+std::filesystem::path result_cache_path()
+{
+    // Name the cache file after the traces, the machine configuration and the simulator version
+    const char *dir = std::getenv("TOMASULO_CACHE_DIR");
+    std::ostringstream name;
+    name << std::hex << fnv1a(SIMULATOR_VERSION, fnv1a(machine_config(), fnv1a(result_cache_trace))) << ".result";
+    return std::filesystem::path(dir != nullptr ? dir : RESULT_CACHE_DIR) / name.str();
+}
+
+bool result_cache_load()
+{
+    std::filesystem::path path = result_cache_path();
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // Check that the entry was written for this trace, configuration and version
+    std::string version, trace, config, field;
+    std::getline(file, version);
+    std::getline(file, trace);
+    std::getline(file, config);
+    if (version != "tomasulo-result " SIMULATOR_VERSION || trace != "trace " + result_cache_trace || config != "config " + machine_config())
+    {
+        return false;
+    }
+
+    // Read the final statistics of the core and of each thread
+    unsigned int cycles = 0;
+    int count = 0;
+    unsigned finish[SMT_MAX_THREADS];
+    bool timeline = false;
+    file >> field >> cycles >> field >> count;
+    if (!file || count != thread_count)
+    {
+        return false;
+    }
+    for (int t = 0; t < thread_count; t++)
+    {
+        size_t size = 0;
+        file >> field >> size >> finish[t];
+        if (!file || size != threads[t].inst_list.size())
+        {
+            return false;
+        }
+    }
+
+    // Read the execution port statistics
+    dispatch_stats_t stats = {};
+    file >> field;
+    for (int c = 0; c < STATION_TYPES; c++)
+    {
+        file >> stats.waits[c];
+        for (int k = 0; k < dispatch_ports[c]; k++)
+        {
+            file >> stats.grants[c][k];
+        }
+    }
+
+    // Read the optional timeline of every thread, missing entries without one when a timeline is wanted
+    file >> field >> timeline;
+    if (!file || (result_cache_timeline && !timeline))
+    {
+        return false;
+    }
+    std::vector<inst_t> times;
+    for (int t = 0; timeline && t < thread_count; t++)
+    {
+        for (size_t i = 0; i < threads[t].inst_list.size(); i++)
+        {
+            inst_t time;
+            file >> time.issue >> time.exec >> time.write >> time.commit;
+            times.push_back(time);
+        }
+    }
+    if (!file)
+    {
+        return false;
+    }
+
+    // Finish the simulation with the cached results
+    size_t k = 0;
+    for (int t = 0; t < thread_count; t++)
+    {
+        for (size_t i = 0; timeline && i < threads[t].inst_list.size(); i++, k++)
+        {
+            threads[t].inst_list[i].issue = times[k].issue;
+            threads[t].inst_list[i].exec = times[k].exec;
+            threads[t].inst_list[i].write = times[k].write;
+            threads[t].inst_list[i].commit = times[k].commit;
+        }
+        threads[t].insts.clear();
+        threads[t].next_reorder = threads[t].inst_list.size();
+        threads[t].finish = finish[t];
+    }
+    ticks = cycles;
+    dispatch_stats = stats;
+    result_cache_stored = true;
+    result_cache_hit = true;
+
+    // Mark the entry as recently used
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void result_cache_evict(const std::filesystem::path &dir)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    uintmax_t total = 0;
+    auto now = fs::file_time_type::clock::now();
+
+    // Collect the cached results and remove temporary files abandoned by failed writers
+    for (const fs::directory_entry &e : fs::directory_iterator(dir, ec))
+    {
+        fs::file_time_type time = e.last_write_time(ec);
+        uintmax_t size = e.file_size(ec);
+        if (ec)
+        {
+            continue; // Removed by another process
+        }
+        if (e.path().extension() == ".result")
+        {
+            entries.push_back({time, e.path()});
+            total += size;
+        }
+        else if (e.path().extension() == ".tmp" && now - time > std::chrono::seconds(RESULT_CACHE_STALE_SECONDS))
+        {
+            fs::remove(e.path(), ec);
+        }
+    }
+
+    // Remove the least recently used results until the cache fits
+    std::sort(entries.begin(), entries.end());
+    for (const auto &e : entries)
+    {
+        if (total <= (uintmax_t)RESULT_CACHE_MAX_BYTES)
+        {
+            break;
+        }
+        uintmax_t size = fs::file_size(e.second, ec);
+        if (!ec && fs::remove(e.second, ec))
+        {
+            total -= size;
+        }
+    }
+}
+
+void result_cache_store()
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!result_cache_enabled || result_cache_stored)
+    {
+        return;
+    }
+    result_cache_stored = true;
+    fs::path path = result_cache_path();
+    fs::create_directories(path.parent_path(), ec);
+
+    // Write to a file private to this process
+    std::ostringstream tmp_name;
+    tmp_name << path.filename().string() << "." << getpid() << ".tmp";
+    fs::path tmp = path.parent_path() / tmp_name.str();
+    std::ofstream file(tmp);
+    file << "tomasulo-result " SIMULATOR_VERSION "\n";
+    file << "trace " << result_cache_trace << "\n";
+    file << "config " << machine_config() << "\n";
+    file << "cycles " << ticks << "\n";
+    file << "threads " << thread_count << "\n";
+    for (int t = 0; t < thread_count; t++)
+    {
+        file << "thread " << threads[t].inst_list.size() << " " << threads[t].finish << "\n";
+    }
+    file << "ports";
+    for (int c = 0; c < STATION_TYPES; c++)
+    {
+        file << " " << dispatch_stats.waits[c];
+        for (int k = 0; k < dispatch_ports[c]; k++)
+        {
+            file << " " << dispatch_stats.grants[c][k];
+        }
+    }
+    file << "\n";
+    file << "timeline " << result_cache_timeline << "\n";
+    for (int t = 0; result_cache_timeline && t < thread_count; t++)
+    {
+        for (const inst_t &i : threads[t].inst_list)
+        {
+            file << i.issue << " " << i.exec << " " << i.write << " " << i.commit << "\n";
+        }
+    }
+    file.close();
+
+    // Publish the complete file atomically so readers never see a partial entry
+    if (file)
+    {
+        fs::rename(tmp, path, ec);
+    }
+    if (!file || ec)
+    {
+        fs::remove(tmp, ec);
+        std::cout << "Could not write result cache: " << path.string() << "\n";
+        return;
+    }
+    result_cache_evict(path.parent_path());
+}
+
+void result_cache_show()
+{
+    // Print result cache mode and location
+    std::cout << "Result cache: " << (result_cache_enabled ? (result_cache_timeline ? "timeline" : "on") : "off") << "\n";
+    std::cout << "File: " << result_cache_path().string() << "\n";
+    std::cout << "\n"; // Add a newline for better readability
+}
+
+fu_t *find_station(int id)
+{
+    // Find the functional unit with the given identifier
+    for (int i = 0; i < STATION_TYPES; i++)
+    {
+        for (int j = 0; j < station_sizes[i]; j++)
+        {
+            if (all_stations[i][j].id == id)
+            {
+                return &all_stations[i][j];
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool parse_breakpoint(std::istringstream &args, breakpoint_t *bp)
+{
+    std::string kind, arg;
+    args >> kind >> arg;
+    if (arg.empty())
+    {
+        return false;
+    }
+
+    if (kind == "busy")
+    {
+        // Look up the station by name
+        auto name = std::find(str_fus + 1, str_fus + ALL_STATIONS + 1, arg);
+        bp->kind = brk_busy;
+        bp->arg = (int)(name - str_fus) - 1;
+        return name != str_fus + ALL_STATIONS + 1;
+    }
+    if (kind == "reg")
+    {
+        // Look up the register by the name used in instruction files
+        auto name = std::find(str_trace_reg, str_trace_reg + REGISTERS_MAX, arg);
+        bp->kind = brk_reg;
+        bp->arg = (int)(name - str_trace_reg);
+        return name != str_trace_reg + REGISTERS_MAX;
+    }
+
+    // Parse a numeric condition, where instructions of other threads are given as <thread>:<index>
+    static const std::map<std::string, break_t> kinds = {
+        {"cycle", brk_cycle}, {"issue", brk_issue}, {"write", brk_write}, {"commit", brk_commit}, {"stall", brk_stall}};
+    auto k = kinds.find(kind);
+    bp->kind = k != kinds.end() ? k->second : brk_cycle;
+    bp->thread = 0;
+    bool is_inst = bp->kind == brk_issue || bp->kind == brk_write || bp->kind == brk_commit;
+    size_t colon = arg.find(':');
+    if (is_inst && colon != std::string::npos && colon > 0 && arg.find_first_not_of("0123456789") == colon)
+    {
+        bp->thread = std::stoi(arg.substr(0, colon));
+        arg = arg.substr(colon + 1);
+    }
+    if (k == kinds.end() || arg.empty() || arg.find_first_not_of("0123456789") != std::string::npos || bp->thread >= thread_count)
+    {
+        return false;
+    }
+    bp->arg = std::stoi(arg);
+    if (bp->kind == brk_stall)
+    {
+        return bp->arg >= 1; // A stall of 0 cycles would also hold on cycles that issue
+    }
+    return !is_inst || bp->arg < (int)threads[bp->thread].inst_list.size();
+}
+
+std::string breakpoint_str(const breakpoint_t &bp)
+{
+    // Describe the condition the way it is entered
+    std::string inst = (bp.thread != 0 ? std::to_string(bp.thread) + ":" : "") + std::to_string(bp.arg);
+    switch (bp.kind)
+    {
+    case brk_cycle:
+        return "cycle " + std::to_string(bp.arg);
+    case brk_issue:
+        return "issue " + inst;
+    case brk_write:
+        return "write " + inst;
+    case brk_commit:
+        return "commit " + inst;
+    case brk_busy:
+        return "busy " + str_fus[bp.arg + 1];
+    case brk_reg:
+        return "reg " + str_trace_reg[bp.arg];
+    default:
+        return "stall " + std::to_string(bp.arg);
+    }
+}
+
+bool breakpoint_hit(const breakpoint_t &bp, const inst_t &before, const bool *busy_before, const unsigned long *writes_before, int stall)
+{
+    // Check whether the last cycle met the condition
+    const std::vector<inst_t> &inst_list = threads[bp.thread].inst_list;
+    switch (bp.kind)
+    {
+    case brk_cycle:
+        return ticks == (unsigned)bp.arg;
+    case brk_issue:
+        return before.issue == 0 && inst_list[bp.arg].issue != 0;
+    case brk_write:
+        return before.write == 0 && inst_list[bp.arg].write != 0;
+    case brk_commit:
+        return before.commit == 0 && inst_list[bp.arg].commit != 0;
+    case brk_busy:
+        return !busy_before[bp.arg] && find_station(bp.arg)->busy;
+    case brk_reg:
+        return writes_before[bp.arg] != reg_writes[bp.arg];
+    default:
+        return stall == bp.arg;
+    }
+}
+
+size_t queued_count()
+{
+    // Count the instructions of all threads waiting to issue
+    size_t count = 0;
+    for (int t = 0; t < thread_count; t++)
+    {
+        count += threads[t].insts.size();
+    }
+    return count;
+}
+
+size_t committed_count()
+{
+    // Count the instructions of all threads already committed
+    size_t count = 0;
+    for (int t = 0; t < thread_count; t++)
+    {
+        count += threads[t].next_reorder;
+    }
+    return count;
+}
+
+bool run(const std::vector<breakpoint_t> &conditions)
+{
+    unsigned start_ticks = ticks;
+    size_t start_queued = queued_count();
+    size_t start_committed = committed_count();
+    int stall = 0;
+    bool finished = false;
+    std::vector<std::string> reasons;
+
+    // Stop on the requested conditions as well as on every breakpoint
+    std::vector<breakpoint_t> all(conditions);
+    all.insert(all.end(), breakpoints.begin(), breakpoints.end());
+    std::vector<inst_t> insts_before(all.size());
+    bool busy_before[ALL_STATIONS];
+    regstat_t regs_before[REGISTERS_MAX + 1];
+    unsigned long writes_before[REGISTERS_MAX + 1];
+
+    // Do not run past cycles and instruction events that already happened
+    for (const breakpoint_t &bp : conditions)
+    {
+        if (bp.kind == brk_cycle && (unsigned)bp.arg <= ticks)
+        {
+            reasons.push_back(breakpoint_str(bp) + " (already reached)");
+        }
+        int inst_t::*field = bp.kind == brk_issue ? &inst_t::issue : bp.kind == brk_write ? &inst_t::write : bp.kind == brk_commit ? &inst_t::commit : nullptr;
+        if (field != nullptr && threads[bp.thread].inst_list[bp.arg].*field != 0)
+        {
+            reasons.push_back(breakpoint_str(bp) + " (already at cycle " + std::to_string(threads[bp.thread].inst_list[bp.arg].*field) + ")");
+        }
+    }
+
+    while (reasons.empty())
+    {
+        // Save the state the conditions compare against
+        for (size_t b = 0; b < all.size(); b++)
+        {
+            bool is_inst = all[b].kind == brk_issue || all[b].kind == brk_write || all[b].kind == brk_commit;
+            insts_before[b] = is_inst ? threads[all[b].thread].inst_list[all[b].arg] : inst_t();
+        }
+        for (int i = 0; i < STATION_TYPES; i++)
+        {
+            for (int j = 0; j < station_sizes[i]; j++)
+            {
+                busy_before[all_stations[i][j].id] = all_stations[i][j].busy;
+            }
+        }
+        std::copy(registers, registers + REGISTERS_MAX + 1, regs_before);
+        std::copy(reg_writes, reg_writes + REGISTERS_MAX + 1, writes_before);
+        size_t queued = queued_count();
+
+        // Execute one cycle without output
+        if (exec())
+        {
+            reasons.push_back("all operations done");
+            finished = true;
+            break;
+        }
+
+        // Count consecutive cycles that issued nothing
+        stall = queued_count() == queued && queued > 0 ? stall + 1 : 0;
+
+        // Check the conditions and the watchpoints
+        for (size_t b = 0; b < all.size(); b++)
+        {
+            if (breakpoint_hit(all[b], insts_before[b], busy_before, writes_before, stall))
+            {
+                reasons.push_back(breakpoint_str(all[b]));
+            }
+        }
+        for (reg_t r : watchpoints)
+        {
+            // Describe every field of the register status that changed
+            const regstat_t &o = regs_before[r], &n = registers[r];
+            std::ostringstream change;
+            if (o.value != n.value)
+                change << " value " << o.value << " -> " << n.value;
+            if (o.used_as != n.used_as)
+                change << " used as " << str_used[o.used_as] << " -> " << str_used[n.used_as];
+            if (o.dest_used_by != n.dest_used_by)
+                change << " written by " << str_fus[o.dest_used_by + 1] << " -> " << str_fus[n.dest_used_by + 1];
+            if (o.renamed_to != n.renamed_to)
+                change << " renamed to " << str_trace_reg[o.renamed_to] << " -> " << str_trace_reg[n.renamed_to];
+            if (o.renamed_from != n.renamed_from)
+                change << " renamed from " << str_trace_reg[o.renamed_from] << " -> " << str_trace_reg[n.renamed_from];
+            if (o.rename_ref_count != n.rename_ref_count)
+                change << " references " << o.rename_ref_count << " -> " << n.rename_ref_count;
+            if (!change.str().empty())
+            {
+                reasons.push_back("watch " + str_trace_reg[r] + ":" + change.str());
+            }
+        }
+    }
+
+    // Count the instructions written back during the run
+    size_t written = 0;
+    for (int t = 0; t < thread_count; t++)
+    {
+        for (const inst_t &i : threads[t].inst_list)
+        {
+            if (i.write > (int)start_ticks)
+            {
+                written++;
+            }
+        }
+    }
+
+    // Print a summary of the run
+    std::cout << "Stopped at cycle " << ticks << " after " << ticks - start_ticks << " cycles:\n";
+    for (const std::string &r : reasons)
+    {
+        std::cout << "\t" << r << "\n";
+    }
+    std::cout << "Issued: " << start_queued - queued_count() << "\tWritten: " << written << "\tCommitted: " << committed_count() - start_committed << "\n";
+    std::cout << "\n"; // Add a newline for better readability
+    return finished;
+}
+
+void threads_show()
+{
+    // Print the issue policy and the throughput of each thread
+    std::cout << "Threads (" << (smt_policy == icount ? "ICOUNT" : "round-robin") << " issue):\n";
+    std::cout << "Thread\tInsts\tCommit\tFinish\tIPC\tFile\n";
+    for (int t = 0; t < thread_count; t++)
+    {
+        const thread_t &th = threads[t];
+        unsigned cycles = th.finish != 0 ? th.finish : ticks;
+        std::cout << t << "\t" << th.inst_list.size() << "\t" << th.next_reorder << "\t";
+        if (th.finish != 0)
+        {
+            std::cout << th.finish;
+        }
+        std::cout << "\t" << (cycles > 0 ? (double)th.next_reorder / cycles : 0) << "\t" << th.filename << "\n";
+    }
+
+    // Print the throughput of the whole core
+    std::cout << "Aggregate: " << committed_count() << " instructions committed in " << ticks << " cycles, IPC " << (ticks > 0 ? (double)committed_count() / ticks : 0) << "\n";
+    std::cout << "\n"; // Add a newline for better readability
+}
+
+void ports_show()
+{
+    // Print the dispatch policy and the utilization of each execution port
+    std::cout << "Execution ports (" << str_dispatch_order[dispatch_policy] << "):\n";
+    std::cout << "Class\tPorts\tUtilization\t\tReady, not dispatched\n";
+    for (int c = 0; c < STATION_TYPES; c++)
+    {
+        std::cout << str_class[c] << "\t" << dispatch_ports[c] << "\t";
+        for (int k = 0; k < dispatch_ports[c]; k++)
+        {
+            std::cout << (ticks > 0 ? 100.0 * dispatch_stats.grants[c][k] / ticks : 0) << "% ";
+        }
+        std::cout << "\t\t" << dispatch_stats.waits[c] << " cycles\n";
+    }
+    std::cout << "\n"; // Add a newline for better readability
+}
+
+void report()
+{
+    // Print each thread's dataflow limit next to the cycles it took
+    for (int t = 0; t < thread_count; t++)
+    {
+        if (thread_count > 1)
+        {
+            std::cout << "Thread " << t << " (" << threads[t].filename << ")\n";
+        }
+        dataflow_show(threads[t].dataflow, threads[t].finish != 0 ? threads[t].finish : ticks);
+    }
+
+    // Compare the threads when they share the core
+    if (thread_count > 1)
+    {
+        threads_show();
+    }
+    ports_show(); // Display the execution port utilization
+}
+
+void fus()
+{
+    // Print header for functional units status
+    std::cout << "Unidades Funcionais:\n";
+    std::cout << "Time\tFU\tBusy\tOp\tVi\tVj\tVk\tQj\tQk\n";
+
+    // Loop through all functional units
+    for (int i = 0; i < STATION_TYPES; i++)
+    {
+        for (int j = 0; j < station_sizes[i]; j++)
+        {
+            // Print status of each functional unit
+            if (all_stations[i][j].time_left != -1)
+            {
+                // Print remaining execution time if the unit is busy
+                std::cout << all_stations[i][j].time_left;
+            }
+            std::cout << "\t" << str_fus[(2 * i) + j + 1] << "\t" << all_stations[i][j].busy << "\t"; // Print unit ID and busy status
+
+            if (all_stations[i][j].busy)
+            {
+                // If the unit is busy, print the operation it is executing
+                std::cout << str_op[all_stations[i][j].inst->op];
+            }
+            else
+            {
+                // If the unit is idle, print a dash
+                std::cout << "-";
+            }
+            std::cout << "\t";
+
+            if (all_stations[i][j].inst != nullptr)
+            {
+                // If there is an instruction in the unit, print its destination register
+                std::cout << str_reg[all_stations[i][j].inst->dest];
+            }
+            else
+            {
+                // If no instruction is in the unit, print a dash
+                std::cout << "-";
+            }
+            std::cout << "\t" << str_reg[all_stations[i][j].vj] << "\t" << str_reg[all_stations[i][j].vk] << "\t"; // Print source operands (Vj and Vk)
+
+            // Print reservation stations for source operands (Qj and Qk)
+            std::cout << str_fus[all_stations[i][j].qj + 1] << "\t" << str_fus[all_stations[i][j].qk + 1] << "\n";
+        }
+    }
+    std::cout << "\n"; // Add a newline for better readability
+}
+
+void show()
+{
+    // Print header for the registers display
+    std::cout << "Registradores: \n";
+    std::cout << "Visiveis       |      Invisiveis\n";
+
+    // Loop through visible registers and their corresponding invisible registers
+    for (int i = 1; i <= VISIBLE_REGISTERS; i++)
+    {
+        // Print the value of each visible register and its corresponding invisible registers
+        std::cout << str_reg[i] << ": " << registers[i].value << "\t\t    " << str_reg[i + VISIBLE_REGISTERS] << ": " << registers[i + VISIBLE_REGISTERS].value << "\t" << str_reg[i + (2 * VISIBLE_REGISTERS)] << ": " << registers[i + (2 * VISIBLE_REGISTERS)].value << "\n";
+    }
+    std::cout << "\n"; // Add a newline for better readability
+}
+
+void menu()
+{
+    // Print menu options
+    std::cout << "Menu:\n";
+    std::cout << "\tAll (a)\n";             // Option to execute until all operations are done
+    std::cout << "\tBreakpoint (b [<condition>|clear])\n"; // Option to add or clear breakpoints
+    std::cout << "\tCycle (c)\n";           // Option to execute one cycle
+    std::cout << "\tDataflow limit (d)\n";  // Option to display the dataflow limit of the trace
+    std::cout << "\tExit (e)\n";            // Option to exit the program
+    std::cout << "\tFunctional units (f)\n"; // Option to display functional units status
+    std::cout << "\tResult cache (k [on|off|timeline])\n"; // Option to configure the result cache
+    std::cout << "\tMemoization (m [on|off|verify])\n"; // Option to configure memoization and display its statistics
+    std::cout << "\tNext (n)\n";            // Option to execute until the next instruction is issued
+    std::cout << "\tPorts (p [oldest|youngest|station] | p <add|mult|load> <ports>)\n"; // Option to configure the execution ports
+    std::cout << "\tRegister (r)\n";   // Option to display register values
+    std::cout << "\tThreads (t [rr|icount])\n"; // Option to choose the issue policy and display thread throughput
+    std::cout << "\tUntil (u <condition>)\n"; // Option to execute until a condition is met
+    std::cout << "\tWatchpoint (w [<register>|clear])\n"; // Option to add or clear watchpoints
+    std::cout << "\tConditions: cycle <n>, issue [<thread>:]<i>, write [<thread>:]<i>, commit [<thread>:]<i>, busy <station>, reg <register>, stall <n>\n";
+}
+
+std::vector<inst_t> read(const std::string &filename)
+{
+    std::vector<inst_t> code;
+    static std::map<std::string, op_t> op_map;
+
+    // Initialize op_map if empty
+    if (op_map.empty())
+    {
+        // Mapping operation strings to op_t enum values
+        op_map["add"] = add;
+        op_map["sub"] = sub;
+        op_map["mul"] = mul;
+        op_map["div"] = divd;
+        op_map["lw "] = lw;
+        op_map["sw "] = sw;
+    }
+
+    static std::map<std::string, reg_t> reg_map;
+
+    // Initialize reg_map if empty
+    if (reg_map.empty())
+    {
+        // Mapping register strings to reg_t enum values
+        // Mapping visible registers
+        reg_map["r0"] = r0;
+        reg_map["r1"] = r1;
+        reg_map["r2"] = r2;
+        reg_map["r3"] = r3;
+        reg_map["r4"] = r4;
+        reg_map["r5"] = r5;
+        reg_map["r6"] = r6;
+        reg_map["r7"] = r7;
+        reg_map["r8"] = r8;
+        reg_map["r9"] = r9;
+        reg_map["r10"] = r10;
+        reg_map["r11"] = r11;
+        reg_map["ra"] = ra;
+        reg_map["rb"] = rb;
+        reg_map["rc"] = rc;
+        reg_map["rd"] = rd;
+        reg_map["re"] = re;
+        reg_map["rf"] = rf;
+        reg_map["rg"] = rg;
+        reg_map["rh"] = rh;
+        reg_map["ri"] = ri;
+        reg_map["rj"] = rj;
+        reg_map["rk"] = rk;
+        reg_map["rl"] = rl;
+        reg_map["rm"] = rm;
+        reg_map["rn"] = rn;
+        reg_map["ro"] = ro;
+        reg_map["rp"] = rp;
+        reg_map["rq"] = rq;
+        reg_map["rr"] = rr;
+        reg_map["rs"] = rs;
+        reg_map["rt"] = rt;
+        reg_map["ru"] = ru;
+        reg_map["rv"] = rv;
+        reg_map["rw"] = rw;
+        reg_map["rx"] = rx;
+    }
+
+    static int op_time[6] = {add_time, sub_time, mul_time, div_time, lw_time, sw_time};
 
     std::string raw_inst;
     // Open the file for reading
@@ -620,28 +1883,103 @@ std::vector<inst_t> read(const std::string &filename)
         std::cout << "Error opening file: " << filename << std::endl;
     }
 
-    for (auto &i : code)
+    return code; // Return vector containing parsed instructions
+}
+
+bool load_thread(const std::string &filename, bool smt)
+{
+    int t = thread_count;
+    thread_t &th = threads[t];
+
+    // Read instructions from the file
+    th.filename = filename;
+    th.inst_list = read(filename);
+    if (th.inst_list.empty())
+    {
+        std::cout << "Invalid file name or empty file\n";
+        return false;
+    }
+
+    // Registers past the visible ones hold other threads' architectural registers or renames when several threads are loaded
+    for (const inst_t &i : th.inst_list)
     {
-        insts.push_back(&i);
+        for (reg_t r : {i.dest, i.src1, i.src2})
+        {
+            if (smt && r >= VISIBLE_REGISTERS && r != noreg)
+            {
+                std::cout << filename << ": register " << str_trace_reg[r] << " cannot be used when several threads are loaded (use r0-r11)\n";
+                return false;
+            }
+        }
     }
-    return code; // Return vector containing parsed instructions
+
+    // Analyze the trace before its registers are mapped and renamed
+    dataflow_init(&th.dataflow);
+    for (const inst_t &i : th.inst_list)
+    {
+        dataflow_add(&th.dataflow, i);
+    }
+
+    // Map the architectural registers: the first thread uses the visible registers, the others pin a bank of physical registers
+    for (int k = 0; k < VISIBLE_REGISTERS; k++)
+    {
+        th.arch_map[k] = (reg_t)(VISIBLE_REGISTERS * t + k);
+        registers[th.arch_map[k]].reserved = t > 0;
+    }
+    auto map = [&th](reg_t r) { return r < VISIBLE_REGISTERS ? th.arch_map[r] : r; };
+
+    // Queue the instructions with their physical registers
+    for (inst_t &i : th.inst_list)
+    {
+        i.thread = t;
+        i.dest = map(i.dest);
+        i.src1 = map(i.src1);
+        i.src2 = map(i.src2);
+        th.insts.push_back(&i);
+    }
+    th.next_reorder = 0;
+    th.finish = 0;
+    thread_count++;
+    return true;
 }
 
 int main()
 {
-    std::string filename;
+    std::string filenames, filename;
+    std::vector<std::string> files;
 
     std::cout << "Tomasulo simulator\n";
-    std::cout << "Enter the instruction file name: ";
-    std::getline(std::cin, filename); // Get the instruction file name from the user
+    std::cout << "Enter the instruction file names (one per hardware thread): ";
+    std::getline(std::cin, filenames); // Get the instruction file names from the user
 
-    std::vector<inst_t> inst_list = read(filename); // Read instructions from the file
-    if (inst_list.empty())
+    // Load each file as a hardware thread
+    std::istringstream names(filenames);
+    while (names >> filename)
+    {
+        files.push_back(filename);
+    }
+    if (files.size() > SMT_MAX_THREADS)
+    {
+        std::cout << "At most " << SMT_MAX_THREADS << " threads are supported\n";
+        return 1;
+    }
+    for (const std::string &file : files)
+    {
+        if (!load_thread(file, files.size() > 1))
+        {
+            return 1; // If file reading failed, the file is empty or it uses reserved registers, return error code 1
+        }
+    }
+    if (thread_count == 0)
     {
         std::cout << "Invalid file name or empty file\n";
-        return 1; // If file reading failed or file is empty, return error code 1
+        return 1;
     }
 
+    // Locate the cached results, enabling the cache when a directory is configured
+    result_cache_open();
+    result_cache_enabled = std::getenv("TOMASULO_CACHE_DIR") != nullptr;
+
     std::string input;
     init_fus(); // Initialize functional units
 
@@ -649,9 +1987,15 @@ int main()
     {
         std::cout << ">"; // Display prompt
         std::getline(std::cin, input); // Get user input
+        std::string command = input.substr(0, input.find(' '));
+        std::istringstream args(input.substr(command.size()));
 
         // Handle user commands
-        if (input == "registers" || input == "r")
+        if ((input == "registers" || input == "r" || input == "fus" || input == "f") && result_cache_hit)
+        {
+            std::cout << "Registers and functional units are not simulated after a result cache hit\n";
+        }
+        else if (input == "registers" || input == "r")
         {
             show(); // Display register values
         }
@@ -664,12 +2008,207 @@ int main()
             if (exec()) // Execute one cycle of the simulator
             {
                 std::cout << "All operations done\n";
+                result_cache_store(); // Save the results for later runs
+                report(); // Display the dataflow limit next to the simulated cycles
             }
             else
             {
                 std::cout << "Cycle: " << ticks << "\n"; // Display current cycle
             }
         }
+        else if (input == "all" || input == "a")
+        {
+            bool finished = true;
+            if (!breakpoints.empty() || !watchpoints.empty())
+            {
+                finished = run({}); // Execute until a breakpoint or watchpoint stops the run
+            }
+            else if (ticks == 0 && result_cache_enabled && result_cache_load())
+            {
+                std::cout << "Result cache hit\n";
+            }
+            else
+            {
+                // Execute until all operations are done, replaying memoized steps when enabled
+                while (!memo_exec())
+                {
+                }
+            }
+            if (finished)
+            {
+                std::cout << "All operations done\n";
+                result_cache_store(); // Save the results for later runs
+            }
+            std::cout << "Cycle: " << ticks << "\n"; // Display current cycle
+            if (finished)
+            {
+                report(); // Display the dataflow limit next to the simulated cycles
+            }
+        }
+        else if (command == "until" || command == "u")
+        {
+            // Execute until the condition, a breakpoint or a watchpoint stops the run
+            breakpoint_t bp;
+            if (!parse_breakpoint(args, &bp))
+            {
+                std::cout << "Invalid condition\n";
+                menu(); // Display menu options
+            }
+            else if (run({bp}))
+            {
+                result_cache_store(); // Save the results for later runs
+                report(); // Display the dataflow limit next to the simulated cycles
+            }
+        }
+        else if (command == "break" || command == "b")
+        {
+            // Add a breakpoint, or clear them all
+            breakpoint_t bp;
+            std::string first;
+            std::istringstream(args.str()) >> first;
+            if (first == "clear")
+            {
+                breakpoints.clear();
+            }
+            else if (!first.empty() && parse_breakpoint(args, &bp))
+            {
+                breakpoints.push_back(bp);
+            }
+            else if (!first.empty())
+            {
+                std::cout << "Invalid condition\n";
+            }
+
+            // List the breakpoints
+            std::cout << "Breakpoints:\n";
+            for (const breakpoint_t &b : breakpoints)
+            {
+                std::cout << "\t" << breakpoint_str(b) << "\n";
+            }
+            std::cout << "\n"; // Add a newline for better readability
+        }
+        else if (command == "watch" || command == "w")
+        {
+            // Add a watchpoint, or clear them all
+            std::string name;
+            args >> name;
+            auto reg = std::find(str_trace_reg, str_trace_reg + REGISTERS_MAX, name);
+            if (name == "clear")
+            {
+                watchpoints.clear();
+            }
+            else if (reg != str_trace_reg + REGISTERS_MAX)
+            {
+                watchpoints.push_back((reg_t)(reg - str_trace_reg));
+            }
+            else if (!name.empty())
+            {
+                std::cout << "Invalid register\n";
+            }
+
+            // List the watchpoints
+            std::cout << "Watchpoints:\n";
+            for (reg_t r : watchpoints)
+            {
+                std::cout << "\t" << str_trace_reg[r] << "\n";
+            }
+            std::cout << "\n"; // Add a newline for better readability
+        }
+        else if (input == "dataflow" || input == "d")
+        {
+            report(); // Display the dataflow limit of the traces
+        }
+        else if (command == "memo" || command == "m")
+        {
+            // Parse the optional memoization mode
+            std::string mode;
+            args >> mode;
+
+            if (mode == "on" || mode == "verify")
+            {
+                memo_enabled = true;
+                memo_verify = mode == "verify";
+            }
+            else if (mode == "off")
+            {
+                memo_enabled = false;
+                memo_verify = false;
+            }
+            else if (!mode.empty())
+            {
+                std::cout << "Invalid memoization mode\n";
+            }
+            memo_show(); // Display memoization mode and statistics
+        }
+        else if (command == "threads" || command == "t")
+        {
+            // Parse the optional issue policy
+            std::string policy;
+            args >> policy;
+
+            if (!policy.empty() && ticks != 0)
+            {
+                std::cout << "The issue policy can only change before the first cycle\n";
+            }
+            else if (policy == "rr" || policy == "icount")
+            {
+                smt_policy = policy == "rr" ? round_robin : icount;
+            }
+            else if (!policy.empty())
+            {
+                std::cout << "Invalid issue policy\n";
+            }
+            threads_show(); // Display the issue policy and the throughput of each thread
+        }
+        else if (command == "ports" || command == "p")
+        {
+            // Parse the optional dispatch policy, or unit class and number of ports
+            std::string first;
+            int ports = 0;
+            args >> first;
+            auto policy = std::find(str_dispatch, str_dispatch + 3, first);
+            auto unit = std::find(str_class, str_class + STATION_TYPES, first);
+
+            if (!first.empty() && ticks != 0)
+            {
+                std::cout << "Execution ports can only change before the first cycle\n";
+            }
+            else if (policy != str_dispatch + 3)
+            {
+                dispatch_policy = (dispatch_policy_t)(policy - str_dispatch);
+            }
+            else if (unit != str_class + STATION_TYPES && args >> ports && ports >= 1 && ports <= station_sizes[unit - str_class])
+            {
+                dispatch_ports[unit - str_class] = ports;
+            }
+            else if (!first.empty())
+            {
+                std::cout << "Invalid dispatch policy or number of ports\n";
+            }
+            ports_show(); // Display the dispatch policy and the execution port utilization
+        }
+        else if (command == "cache" || command == "k")
+        {
+            // Parse the optional result cache mode
+            std::string mode;
+            args >> mode;
+
+            if (mode == "on" || mode == "timeline")
+            {
+                result_cache_enabled = true;
+                result_cache_timeline = mode == "timeline";
+            }
+            else if (mode == "off")
+            {
+                result_cache_enabled = false;
+                result_cache_timeline = false;
+            }
+            else if (!mode.empty())
+            {
+                std::cout << "Invalid result cache mode\n";
+            }
+            result_cache_show(); // Display result cache mode and location
+        }
         else if (input == "clock" || input == "c")
         {
             std::cout << "Cycle: " << ticks << "\n"; // Display current cycle
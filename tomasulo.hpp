@@ -3,6 +3,7 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 // Define the maximum number of visible and invisible registers
 #define VISIBLE_REGISTERS 12
@@ -44,6 +45,7 @@ struct regstat_t {
     reg_t renamed_to;       // Renamed to register
     reg_t renamed_from;     // Renamed from register
     int rename_ref_count;   // Number of references to the renamed register
+    bool reserved;          // Indicates if the register holds an architectural register of another thread
 };
 
 // Structure to represent an instruction
@@ -58,6 +60,7 @@ struct inst_t {
     int exec;       // Time when the instruction started execution
     int write;      // Time when the instruction finished execution (write-back)
     int commit;     // Time when the instruction committed
+    int thread;     // Hardware thread the instruction belongs to
 };
 
 // Define execution times for different operations
@@ -87,6 +90,160 @@ struct fu_t {
     int time_left;      // Time left for execution
     bool locks1;        // Indicates if source register 1 is locked
     bool locks2;        // Indicates if source register 2 is locked
+    bool dispatched;    // Indicates if the instruction was granted an execution port
+    unsigned long seq;  // Issue order of the instruction, used to dispatch by age
+};
+
+// Define the number of execution ports of each unit class (at most its number of stations)
+#define ADD_PORTS ADD_STATIONS
+#define MUL_PORTS MUL_STATIONS
+#define LOAD_PORTS LOAD_STATIONS
+
+// Enumerate the policies that order ready stations competing for execution ports
+enum dispatch_policy_t {
+    oldest_first,       // Lowest issue order first
+    youngest_first,     // Highest issue order first
+    station_order       // Fixed order of the stations in all_stations
+};
+
+// Structure to store execution port statistics
+struct dispatch_stats_t {
+    unsigned long grants[STATION_TYPES][ALL_STATIONS];  // Instructions started on each port of each unit class
+    unsigned long waits[STATION_TYPES];                 // Cycles stations spent ready but not dispatched
+};
+
+// Enumerate the conditions that stop a run
+enum break_t {
+    brk_cycle,      // Cycle reached
+    brk_issue,      // Instruction issued
+    brk_write,      // Instruction written back
+    brk_commit,     // Instruction committed
+    brk_busy,       // Station became busy
+    brk_reg,        // Register written back
+    brk_stall       // No instruction issued for a number of cycles
+};
+
+// Structure to represent a condition that stops a run
+struct breakpoint_t {
+    break_t kind;   // Condition type
+    int arg;        // Cycle, instruction index, station identifier, register or stall length
+    int thread;     // Hardware thread of the instruction (instruction conditions only)
+};
+
+// Define memoization parameters
+#define MEMO_WINDOW 64          // Number of instructions issued by each memoized step
+#define MEMO_CACHE_SIZE 1024    // Maximum number of cached steps (least recently used are evicted)
+// Reference counts above the number of releases a step can perform behave alike, so keys saturate there
+#define MEMO_REF_LIMIT (3 * (ALL_STATIONS + MEMO_WINDOW) + 1)
+
+// Structure to store the fields of an instruction that affect timing
+struct memo_inst_t {
+    op_t op;        // Operation
+    reg_t dest;     // Destination register (after renaming)
+    reg_t src1;     // Source register 1 (after renaming)
+    reg_t src2;     // Source register 2 (after renaming)
+    int time;       // Execution time of the instruction
+};
+
+// Structure to store a functional unit in a normalized machine state
+struct memo_fu_t {
+    bool busy;          // Indicates if the unit is busy
+    int inst;           // Instruction index relative to the next issue (in-flight indices are negative, 0 means none)
+    int vj;             // Value of source register 1
+    int vk;             // Value of source register 2
+    int qj;             // Identifier of the instruction producing vj
+    int qk;             // Identifier of the instruction producing vk
+    int time_left;      // Time left for execution
+    bool locks1;        // Indicates if source register 1 is locked
+    bool locks2;        // Indicates if source register 2 is locked
+    bool dispatched;    // Indicates if the instruction was granted an execution port
+    int age;            // Issues since the instruction was issued (0 means none)
+};
+
+// Structure to store a machine state with instruction indices relative to the next issue
+struct memo_state_t {
+    regstat_t registers[REGISTERS_MAX + 1];     // Register status
+    memo_fu_t stations[ALL_STATIONS];           // Functional units
+    std::vector<int> reorder_buffer;            // Relative indices of the instructions waiting to commit
+    int next_reorder;                           // Relative index of the next instruction to commit
+    int dispatch_ports[STATION_TYPES];          // Execution ports of each unit class
+    dispatch_policy_t dispatch_policy;          // Order of the ready stations competing for execution ports
+    std::vector<memo_inst_t> insts;             // Instructions from next_reorder up to the end of the window
+};
+
+// Structure to store a timing field written during a memoized step
+struct memo_event_t {
+    int inst;               // Instruction index relative to the next issue
+    int inst_t::*field;     // Timing field written (issue, exec, write or commit)
+    int delta;              // Cycle written, relative to the first cycle of the step
+};
+
+// Structure to store the outcome of a memoized step
+struct memo_entry_t {
+    memo_state_t result;                // State after the step, relative to the next issue
+    unsigned int ticks;                 // Number of cycles taken by the step
+    int ref_delta[REGISTERS_MAX + 1];   // Change of each register's rename reference count
+    unsigned long write_delta[REGISTERS_MAX + 1];   // Write-backs to each register
+    dispatch_stats_t dispatch_delta;    // Change of the execution port statistics
+    std::vector<memo_event_t> events;   // Timing fields written during the step
+};
+
+// Structure to store memoization statistics
+struct memo_stats_t {
+    unsigned long hits;         // Steps replayed from the cache
+    unsigned long misses;       // Steps simulated cycle by cycle
+    unsigned long evictions;    // Entries dropped from the cache
+    unsigned long verified;     // Hits checked against a full simulation
+    unsigned long mismatches;   // Hits that did not match the full simulation
+    unsigned long cycles;       // Cycles skipped by replaying cached steps
+};
+
+// Define the simulator version, part of every result cache key
+#define SIMULATOR_VERSION "1.3"
+
+// Define result cache parameters
+#define RESULT_CACHE_DIR ".tomasulo-cache"              // Default directory (overridden by TOMASULO_CACHE_DIR)
+#define RESULT_CACHE_MAX_BYTES (64L * 1024 * 1024)      // Total size above which the least recently used results are evicted
+#define RESULT_CACHE_STALE_SECONDS 3600                 // Age after which temporary files left by failed writers are removed
+
+// Define the number of instructions in each window used to measure available ILP
+#define ILP_WINDOW 64
+
+// Structure to store the dataflow-limited schedule of a trace, built one instruction at a time
+struct dataflow_t {
+    unsigned long insts;                            // Number of instructions analyzed
+    unsigned long ready[REGISTERS_MAX + 1];         // Cycle when each register's value becomes ready
+    unsigned long depth[REGISTERS_MAX + 1];         // Instructions on the longest chain producing each register
+    unsigned long cycles;                           // Dataflow-limited cycle count
+    unsigned long path_insts;                       // Instructions on the critical path
+    unsigned long path_end;                         // Index of the last instruction on the critical path
+    unsigned long window_ready[REGISTERS_MAX + 1];  // Ready cycles counting only dependencies within the current window
+    unsigned long window_cycles;                    // Dataflow-limited cycle count of the current window
+    unsigned long windows;                          // Number of complete windows
+    double ilp_sum;                                 // Sum of the ILP of the complete windows
+    double ilp_min;                                 // Lowest ILP of a complete window
+    double ilp_max;                                 // Highest ILP of a complete window
+};
+
+// Define the maximum number of hardware threads (each thread after the first pins VISIBLE_REGISTERS
+// physical registers as its architectural registers, and one bank is left for renaming)
+#define SMT_MAX_THREADS (REGISTERS_MAX / VISIBLE_REGISTERS - 1)
+
+// Enumerate the policies that choose which thread issues each cycle
+enum smt_policy_t {
+    round_robin,    // Rotate the first choice among the threads every cycle
+    icount          // Prefer the thread with the fewest instructions in the stations
+};
+
+// Structure to represent a hardware thread
+struct thread_t {
+    std::string filename;               // Trace file of the thread
+    std::vector<inst_t> inst_list;      // Instructions of the thread
+    std::deque<inst_t *> insts;         // Instructions waiting to issue
+    unsigned next_reorder;              // Index of the next instruction to commit
+    unsigned finish;                    // Cycle when the last instruction committed (0 while running)
+    reg_t arch_map[VISIBLE_REGISTERS];  // Physical register holding each architectural register
+    dataflow_t dataflow;                // Dataflow-limited schedule of the trace
 };
 
 #endif // TOMASULO_H